@@ -0,0 +1,1045 @@
+/*
+Ayrton da Costa Ganem Filho - 14560190
+Luiz Felipe Diniz Costa - 13782032
+Cauê Paiva Lira - 14675416
+*/
+
+// Benchmarks do peripheral SLOW (make bench).
+//
+// Reaproveita o protocolo de slow_peripheral.cpp (sem o main interativo) e
+// mede desde funções isoladas até trocas completas com um central falso em
+// loopback (com atraso simulado no caso do striping). Resultados saem em
+// JSON; com --runs N a suíte roda em N processos e cada benchmark guarda a
+// mediana de cada um. Com --compare, a mediana atual é testada contra o
+// pior processo do baseline mais o ruído entre processos do próprio
+// benchmark. Regressões, benchmarks do baseline ausentes na execução e
+// benchmarks que falham fazem o programa terminar com código 2.
+
+#define SLOW_NO_MAIN
+#include "slow_peripheral.cpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <poll.h>
+#include <random>
+#include <sys/wait.h>
+#include <thread>
+
+using Clock = chrono::steady_clock;
+
+/**
+ * @struct SlowBench
+ * @brief Acesso aos membros privados de UDPPeripheral usados nos benchmarks.
+ */
+struct SlowBench {
+    static uint16_t advertisedWindow(const UDPPeripheral& p) { return p.advertisedWindow(); }
+    static size_t   fragmentSize(const UDPPeripheral& p, size_t r) { return p.fragmentSize(r); }
+    static void     removePending(UDPPeripheral& p, uint32_t ack) { p.removePendingPackets(ack); }
+
+    /**
+     * @brief Enche a fila de retransmissão com @p depth pacotes de DATA_MAX bytes.
+     */
+    static void fillQueue(UDPPeripheral& p, size_t depth) {
+        uint8_t buf[HDR_SIZE + DATA_MAX] = {};
+        p.pendingQueue.clear();
+        p.pendingQueue.reserve(depth);
+        p.bytesInFlight = 0;
+        for (size_t i = 0; i < depth; i++) {
+            p.pendingQueue.emplace_back(buf, sizeof(buf), (uint32_t)i, DATA_MAX);
+            p.bytesInFlight += DATA_MAX;
+        }
+    }
+
+    static void setWindow(UDPPeripheral& p, uint32_t wnd, uint32_t inFlight) {
+        p.window_size   = wnd;
+        p.bytesInFlight = inFlight;
+    }
+
+    /**
+     * @brief Substitui a resolução DNS: connect() tenta @p addrs nessa ordem.
+     */
+    static void setResolved(UDPPeripheral& p, const vector<ResolvedAddr>& addrs) {
+        p.resolved = addrs;
+    }
+
+    /**
+     * @brief Porta do endereço que venceu o connect().
+     */
+    static uint16_t serverPort(const UDPPeripheral& p) {
+        return ntohs(reinterpret_cast<const sockaddr_in&>(p.srv).sin_port);
+    }
+};
+
+// ---------------------- Estatística ----------------------
+
+/**
+ * @struct Result
+ * @brief Amostras de um benchmark (em nanossegundos por operação).
+ */
+struct Result {
+    string         name;
+    vector<double> samples;   ///< ns por operação
+    double         bytes = 0; ///< Bytes de payload por operação (0 = não se aplica)
+    map<string, double> extra; ///< Métricas adicionais gravadas no JSON (ex.: inflight_peak)
+
+    double mean() const {
+        double s = 0;
+        for (double x : samples) s += x;
+        return samples.empty() ? 0 : s / samples.size();
+    }
+    double stddev() const {
+        if (samples.size() < 2) return 0;
+        double m = mean(), s = 0;
+        for (double x : samples) s += (x - m) * (x - m);
+        return sqrt(s / (samples.size() - 1));
+    }
+    double percentile(double q) const {
+        if (samples.empty()) return 0;
+        vector<double> v = samples;
+        sort(v.begin(), v.end());
+        size_t i = (size_t)min<double>(v.size() - 1, floor(q * (v.size() - 1) + 0.5));
+        return v[i];
+    }
+};
+
+/**
+ * @struct Entry
+ * @brief Um benchmark como aparece no JSON: campos numéricos na ordem de
+ *        saída e, em `runs`, a mediana de cada processo que o executou.
+ */
+struct Entry {
+    string                        name;
+    vector<pair<string, double>>  fields;
+    vector<double>                runs;
+
+    bool field(const string& key, double& v) const {
+        for (const auto& kv : fields)
+            if (kv.first == key) { v = kv.second; return true; }
+        return false;
+    }
+};
+
+/**
+ * @brief Mediana de um vetor (0 se vazio).
+ */
+double medianOf(vector<double> v) {
+    if (v.empty()) return 0;
+    sort(v.begin(), v.end());
+    size_t h = v.size() / 2;
+    return v.size() % 2 ? v[h] : (v[h - 1] + v[h]) / 2;
+}
+
+/**
+ * @brief Saída descartada: o peripheral imprime cada cabeçalho em cout.
+ */
+class NullBuf : public streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+// ---------------------- Central falso em loopback ----------------------
+
+/**
+ * @class LoopbackCentral
+ * @brief Central SLOW mínimo (thread própria) para testes de ponta a ponta.
+ *
+ * Responde CONNECT com SETUP, DATA com ACK, DISCONNECT com ACK e REVIVE com
+ * ACK+A/R, sempre anunciando a janela @c wnd. DATA é confirmado de forma
+ * cumulativa por cliente: só o próximo seq esperado é aceito e o ACK leva o
+ * último aceito. Com @c delayMs > 0 cada resposta é retida por esse tempo,
+ * simulando um enlace com RTT maior; com @c loss > 0 cada datagrama
+ * (recebido ou enviado) é descartado com essa probabilidade. feed() entrega
+ * os payloads aceitos a um StripeReassembler e blackholeAfter() derruba o
+ * enlace de uma sessão no meio do stream até ela pedir revive.
+ */
+class LoopbackCentral {
+private:
+    int            fd = -1;
+    uint16_t       port = 0;
+    uint16_t       wnd;
+    chrono::milliseconds delay;
+    double         loss;
+    mt19937        rng{7033};  ///< Semente fixa: perdas reproduzíveis
+    uniform_real_distribution<double> coin{0.0, 1.0};
+    uint32_t       seq = 1000;
+    SID            sid;
+    atomic<bool>   running{false};
+    thread         worker;
+
+    /// Estado de cada cliente (endereço:porta)
+    struct Client {
+        bool     known  = false;
+        uint32_t expect = 0;     ///< Próximo seq de DATA aceito
+        int      data   = 0;     ///< DATA aceitos deste cliente
+        bool     muted  = false; ///< Blackhole: DATA e ACKs descartados nos dois sentidos
+        bool     dead   = false; ///< Blackhole sem volta: REVIVE também é ignorado
+    };
+    map<uint64_t, Client> clients;
+
+    mutex              feedMtx;
+    StripeReassembler* reasm = nullptr; ///< Destino dos payloads aceitos (opcional)
+    int                muteAfter = -1;  ///< DATA de um cliente até derrubá-lo (-1 = desarmado)
+    bool               muteDead  = false; ///< O cliente derrubado não volta com REVIVE
+
+    static uint64_t key(const sockaddr_in& a) {
+        return ((uint64_t)a.sin_addr.s_addr << 16) | a.sin_port;
+    }
+
+    /// Resposta aguardando o atraso simulado (atraso fixo: FIFO = ordem de envio)
+    struct Delayed {
+        Clock::time_point due;
+        uint8_t           buf[HDR_SIZE];
+        sockaddr_in       to;
+    };
+    deque<Delayed> delayed;
+
+    bool lost() { return loss > 0 && coin(rng) < loss; }
+
+    /**
+     * @return seq usado na resposta
+     */
+    uint32_t reply(uint32_t ack, uint32_t flags, const sockaddr_in& to) {
+        uint32_t used = seq++;
+        if (lost()) return used;
+        Header r;
+        r.sid = sid;
+        r.seq = used;
+        r.ack = ack;
+        r.wnd = wnd;
+        r.sf  = flags;
+        Delayed d;
+        d.due = Clock::now() + delay;
+        d.to  = to;
+        serialize(r, d.buf);
+        if (delay.count() == 0) sendto(fd, d.buf, HDR_SIZE, 0, (const sockaddr*)&to, sizeof(to));
+        else delayed.push_back(d);
+        return used;
+    }
+
+    /**
+     * @brief DATA: aceita só o seq esperado (e só se o reassembler aceitar o
+     *        bloco) e confirma cumulativamente o último aceito. O DATA que
+     *        derruba o cliente é aceito mas fica sem ACK.
+     */
+    void onData(const Header& h, const uint8_t* payload, size_t len, const sockaddr_in& from) {
+        Client& c = clients[key(from)];
+        if (c.muted) return;
+        if (!c.known) { c.known = true; c.expect = h.seq; }
+        if (h.seq == c.expect) {
+            lock_guard<mutex> lk(feedMtx);
+            if (!reasm || reasm->accept(payload, len)) {
+                c.expect++;
+                if (++c.data == muteAfter) {
+                    c.muted   = true;
+                    c.dead    = muteDead;
+                    muteAfter = -1;
+                    return;
+                }
+            }
+        }
+        reply(c.expect - 1, FLAG_ACK, from);
+    }
+
+    /**
+     * @brief Envia as respostas atrasadas já vencidas.
+     * @return ms até a próxima vencer (máx. 50)
+     */
+    int flushDelayed() {
+        auto now = Clock::now();
+        while (!delayed.empty() && delayed.front().due <= now) {
+            const Delayed& d = delayed.front();
+            if (!clients[key(d.to)].muted) // ACKs ainda no ar também se perdem
+                sendto(fd, d.buf, HDR_SIZE, 0, (const sockaddr*)&d.to, sizeof(d.to));
+            delayed.pop_front();
+        }
+        if (delayed.empty()) return 50;
+        auto ms = chrono::duration_cast<chrono::milliseconds>(delayed.front().due - now).count();
+        return (int)std::min<int64_t>(50, ms + 1);
+    }
+
+    void loop() {
+        uint8_t buf[HDR_SIZE + DATA_MAX];
+        while (running) {
+            pollfd pfd{fd, POLLIN, 0};
+            int wait = flushDelayed();
+            if (poll(&pfd, 1, wait) <= 0) continue;
+
+            sockaddr_in from; socklen_t fl = sizeof(from);
+            ssize_t n = recvfrom(fd, buf, sizeof(buf), 0, (sockaddr*)&from, &fl);
+            if (n < HDR_SIZE || lost()) continue;
+
+            Header h;
+            deserialize(h, buf);
+            uint32_t f = h.sf & 0x1F;
+
+            if (f == FLAG_C) {                                                       // CONNECT
+                uint32_t setupSeq = reply(h.seq, FLAG_AR, from);
+                Client& c = clients[key(from)];
+                if (!c.known) { c.known = true; c.expect = setupSeq + 1; }
+            }
+            else if (f == (FLAG_C | FLAG_R | FLAG_ACK))   reply(h.seq, FLAG_ACK, from);   // DISCONNECT
+            else if ((f & FLAG_R) && (f & FLAG_ACK)) {                                // REVIVE
+                Client& c = clients[key(from)];
+                if (c.dead) continue;
+                c.known  = true;
+                c.expect = h.seq + 1;
+                c.muted  = false;
+                reply(h.seq, FLAG_ACK | FLAG_AR, from);
+            }
+            else if ((f & FLAG_ACK) && n > HDR_SIZE)                                     // DATA
+                onData(h, buf + HDR_SIZE, n - HDR_SIZE, from);
+        }
+    }
+
+public:
+    explicit LoopbackCentral(uint16_t window = 16384, int delayMs = 0, double lossRate = 0)
+        : wnd(window), delay(delayMs), loss(lossRate) {
+        for (int i = 0; i < 16; i++) sid.b[i] = (uint8_t)(0xA0 + i);
+    }
+    ~LoopbackCentral() { stop(); }
+
+    bool start() {
+        if ((fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) return false;
+        sockaddr_in a{};
+        a.sin_family = AF_INET;
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        a.sin_port = 0;
+        if (bind(fd, (sockaddr*)&a, sizeof(a)) < 0) return false;
+        socklen_t al = sizeof(a);
+        getsockname(fd, (sockaddr*)&a, &al);
+        port = ntohs(a.sin_port);
+        // Várias sessões com janela cheia chegam em rajada: buffer folgado
+        int rcv = SOCKBUF_MAX;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcv, sizeof(rcv));
+        running = true;
+        worker = thread(&LoopbackCentral::loop, this);
+        return true;
+    }
+
+    void stop() {
+        running = false;
+        if (worker.joinable()) worker.join();
+        if (fd >= 0) { close(fd); fd = -1; }
+    }
+
+    uint16_t getPort() const { return port; }
+
+    /**
+     * @brief Entrega os payloads de DATA aceitos a @p r (nullptr desliga).
+     *        Depois de feed(nullptr), @p r pode ser lido sem concorrência.
+     */
+    void feed(StripeReassembler* r) {
+        lock_guard<mutex> lk(feedMtx);
+        reasm = r;
+    }
+
+    /**
+     * @brief O primeiro cliente a ter @p n DATA aceitos perde o enlace: o
+     *        n-ésimo fica sem ACK, os ACKs ainda retidos pelo atraso são
+     *        descartados e os DATA seguintes também, até ele mandar REVIVE
+     *        (com @p dead, nem o REVIVE é respondido).
+     */
+    void blackholeAfter(int n, bool dead = false) {
+        lock_guard<mutex> lk(feedMtx);
+        muteAfter = n;
+        muteDead  = dead;
+    }
+};
+
+// ---------------------- Benchmarks ----------------------
+
+static volatile uint64_t sink; ///< Impede que o compilador elimine o trabalho medido
+static vector<string>    failures; ///< Benchmarks que não produziram resultado
+
+/**
+ * @brief Registra um benchmark que falhou; qualquer falha faz o programa sair com 2.
+ */
+void benchFailed(const string& name, const string& why = "falhou") {
+    cerr << "[ERRO] " << name << ": " << why << "\n";
+    failures.push_back(name);
+}
+
+/**
+ * @brief Mede @p fn em lotes de @p batch chamadas; cada amostra é ns/chamada.
+ */
+template <typename F>
+Result measureBatch(const string& name, size_t samples, size_t batch, F fn) {
+    Result r; r.name = name;
+    for (size_t i = 0; i < batch; i++) fn(); // aquecimento
+    for (size_t s = 0; s < samples; s++) {
+        auto t0 = Clock::now();
+        for (size_t i = 0; i < batch; i++) fn();
+        auto t1 = Clock::now();
+        r.samples.push_back(chrono::duration<double, nano>(t1 - t0).count() / batch);
+    }
+    return r;
+}
+
+void benchMicro(vector<Result>& out, const string& filter) {
+    auto wanted = [&](const string& n) { return n.find(filter) != string::npos; };
+
+    Header h;
+    h.sf = FLAG_ACK | FLAG_MB; h.seq = 123456; h.ack = 654321; h.wnd = 1024; h.fid = 7; h.fo = 3;
+    uint8_t buf[HDR_SIZE];
+
+    if (wanted("micro/serialize"))
+        out.push_back(measureBatch("micro/serialize", 50, 100000, [&] {
+            h.seq++;
+            serialize(h, buf);
+            sink += buf[20];
+        }));
+
+    serialize(h, buf);
+    if (wanted("micro/deserialize"))
+        out.push_back(measureBatch("micro/deserialize", 50, 100000, [&] {
+            Header r;
+            buf[20]++;
+            deserialize(r, buf);
+            sink += r.seq;
+        }));
+
+    UDPPeripheral p;
+    if (wanted("micro/advertisedWindow")) {
+        uint32_t inFlight = 0;
+        out.push_back(measureBatch("micro/advertisedWindow", 50, 100000, [&] {
+            SlowBench::setWindow(p, 16384, (inFlight += 97) & 0x7FFF);
+            sink += SlowBench::advertisedWindow(p);
+        }));
+    }
+
+    // Cada amostra: enche a fila (fora do tempo) e esvazia com um único ACK.
+    // O erase em vector é quadrático, então filas fundas usam menos amostras
+    for (size_t depth : {1, 16, 256, 4096}) {
+        string name = "micro/removePendingPackets/depth=" + to_string(depth);
+        if (!wanted(name)) continue;
+        Result r; r.name = name;
+        int samples = depth >= 1024 ? 30 : 200;
+        for (int s = 0; s < samples; s++) {
+            SlowBench::fillQueue(p, depth);
+            auto t0 = Clock::now();
+            SlowBench::removePending(p, (uint32_t)depth);
+            auto t1 = Clock::now();
+            r.samples.push_back(chrono::duration<double, nano>(t1 - t0).count());
+        }
+        out.push_back(r);
+    }
+
+    // Planejamento da fragmentação de sendData (sem rede): cada fragmento é
+    // confirmado antes do próximo, como em sendWithRetry
+    for (size_t size : {1024, 16384, 65536}) {
+        string name = "micro/fragmentPlan/size=" + to_string(size);
+        if (!wanted(name)) continue;
+        SlowBench::setWindow(p, 4096, 0);
+        out.push_back(measureBatch(name, 50, 10000, [&] {
+            size_t off = 0, frags = 0;
+            while (off < size) {
+                size_t chunk = SlowBench::fragmentSize(p, size - off);
+                if (chunk == 0) break;
+                off += chunk;
+                frags++;
+            }
+            sink += frags;
+        }));
+    }
+}
+
+/**
+ * @brief Mede uma operação de rede @p samples vezes (uma chamada por amostra).
+ *        @p op retorna false em caso de falha, o que aborta o benchmark.
+ */
+template <typename Op, typename Between>
+bool measureOps(Result& r, size_t samples, Op op, Between between) {
+    for (size_t s = 0; s < samples; s++) {
+        auto t0 = Clock::now();
+        bool ok = op();
+        auto t1 = Clock::now();
+        if (!ok) return false;
+        r.samples.push_back(chrono::duration<double, nano>(t1 - t0).count());
+        between();
+    }
+    return true;
+}
+
+void benchLoopback(vector<Result>& out, const string& filter) {
+    auto wanted = [&](const string& n) { return n.find(filter) != string::npos; };
+
+    LoopbackCentral central;
+    if (!central.start()) {
+        benchFailed("loopback", "não foi possível iniciar o central em loopback");
+        return;
+    }
+    uint16_t port = central.getPort();
+
+    if (wanted("loopback/handshake")) {
+        Result r; r.name = "loopback/handshake";
+        bool ok = measureOps(r, 200, [&] {
+            UDPPeripheral p;
+            return p.init("127.0.0.1", port) && p.connect();
+        }, [] {});
+        if (ok) out.push_back(r);
+        else benchFailed(r.name);
+    }
+
+    UDPPeripheral p;
+    if (!p.init("127.0.0.1", port) || !p.connect()) {
+        benchFailed("loopback", "falha ao conectar no central em loopback");
+        return;
+    }
+
+    if (wanted("loopback/ack_latency")) {
+        Result r; r.name = "loopback/ack_latency";
+        string msg(16, 'x');
+        r.bytes = msg.size();
+        if (measureOps(r, 500, [&] { return p.sendData(msg); }, [] {})) out.push_back(r);
+        else benchFailed(r.name);
+    }
+
+    for (size_t size : {1024, 16384, 65536}) {
+        string name = "loopback/bulk/size=" + to_string(size);
+        if (!wanted(name)) continue;
+        Result r; r.name = name;
+        string msg(size, 'b');
+        r.bytes = size;
+        if (measureOps(r, 100, [&] { return p.sendData(msg); }, [] {})) out.push_back(r);
+        else benchFailed(name);
+    }
+
+    if (wanted("loopback/revive")) {
+        Result r; r.name = "loopback/revive";
+        p.storeSession();
+        bool ok = p.disconnect() && measureOps(r, 200, [&] {
+            return p.zeroWay("revive");
+        }, [&] {
+            p.storeSession();
+            p.disconnect();
+        });
+        if (ok) out.push_back(r);
+        else benchFailed(r.name);
+    }
+}
+
+/**
+ * @brief Goodput agregado do StripedSender em função de K, com RTT de 5 ms e
+ *        a janela máxima de 16 bits por sessão. Grava o maior volume em
+ *        trânsito somado entre as sessões (inflight_peak); com K >= 2 ele
+ *        precisa passar de uma janela (64 KB), senão o envio não está em
+ *        pipeline e o benchmark falha.
+ */
+void benchStriped(vector<Result>& out, const string& filter) {
+    const size_t STREAM = 1024 * 1024;
+    string data(STREAM, 's');
+
+    for (size_t k : {1, 2, 4, 8}) {
+        string name = "loopback/striped/k=" + to_string(k);
+        if (name.find(filter) == string::npos) continue;
+
+        LoopbackCentral central(UINT16_MAX, 5);
+        if (!central.start()) {
+            benchFailed(name, "não foi possível iniciar o central em loopback");
+            continue;
+        }
+        StripedSender sender(k);
+        if (!sender.open("127.0.0.1", central.getPort())) {
+            benchFailed(name, "falha ao abrir as sessões");
+            continue;
+        }
+
+        Result r; r.name = name;
+        r.bytes = STREAM;
+        uint32_t streamId = 1;
+        size_t peak = 0;
+        bool ok = measureOps(r, 30, [&] { return sender.send(data, streamId++); },
+                             [&] { peak = std::max(peak, sender.peakInFlight()); });
+        r.extra["inflight_peak"] = (double)peak;
+        if (!ok)
+            benchFailed(name);
+        else if (k >= 2 && peak <= UINT16_MAX)
+            benchFailed(name, "pico em trânsito de " + to_string(peak) + " bytes não passa de uma janela");
+        else
+            out.push_back(r);
+        sender.close();
+    }
+}
+
+/**
+ * @brief Failover do striping: o central derruba o enlace de uma das 4
+ *        sessões no meio de um stream de 256 KB. Cada amostra exige que o
+ *        stream termine e que o StripeReassembler do central reconstrua os
+ *        bytes exatos tendo recebido blocos duplicados (entregues sem ACK e
+ *        reenviados por outra sessão) e fora de ordem (os perdidos chegam
+ *        depois). Em "failover" a sessão travada precisa ser revivida; em
+ *        "failover_dead" o central ignora o REVIVE e send() precisa terminar
+ *        logo após as outras sessões confirmarem tudo, sem esperar a revive.
+ */
+void benchFailover(vector<Result>& out, const string& filter) {
+    // Stall (~1,4 s com RTT de 5 ms) mais folga; esperar a revive inteira
+    // (StripedSender::REVIVE_TIMEOUT_MS) passaria de 3 s
+    const double DEAD_MAX_MS = 2500;
+
+    string data(256 * 1024, '\0');
+    mt19937 rng(7033);
+    for (char& c : data) c = (char)(rng() & 0xFF);
+
+    for (bool dead : {false, true}) {
+        string name = dead ? "loopback/striped/failover_dead" : "loopback/striped/failover";
+        if (name.find(filter) == string::npos) continue;
+
+        Result r; r.name = name;
+        r.bytes = data.size();
+        double dups = 0, ooo = 0, stalls = 0, revives = 0;
+        bool failed = false;
+        for (uint32_t streamId = 1; streamId <= 3; streamId++) {
+            LoopbackCentral central(16384, 5);
+            if (!central.start()) {
+                benchFailed(name, "não foi possível iniciar o central em loopback");
+                failed = true;
+                break;
+            }
+            StripedSender sender(4);
+            if (!sender.open("127.0.0.1", central.getPort())) {
+                benchFailed(name, "falha ao abrir as sessões");
+                failed = true;
+                break;
+            }
+            StripeReassembler reasm(streamId);
+            central.feed(&reasm);
+            central.blackholeAfter(20, dead);
+
+            auto t0 = Clock::now();
+            bool ok = sender.send(data, streamId);
+            auto t1 = Clock::now();
+            central.feed(nullptr);
+            // A sessão sem enlace não responderia ao DISCONNECT
+            if (!dead) sender.close();
+
+            double ms = chrono::duration<double, milli>(t1 - t0).count();
+            StripeStats total;
+            for (const StripeStats& st : sender.stats()) {
+                total.stalls  += st.stalls;
+                total.revives += st.revives;
+            }
+            string why;
+            if (!ok)                              why = "send() não terminou";
+            else if (!reasm.complete())           why = "stream incompleto no central";
+            else if (reasm.take() != data)        why = "bytes reconstruídos diferem do original";
+            else if (total.stalls == 0)           why = "nenhuma sessão travou";
+            else if (!dead && total.revives == 0) why = "a sessão travada não foi revivida";
+            else if (dead && ms > DEAD_MAX_MS)    why = "send() esperou a revive da sessão morta ("
+                                                        + to_string((int)ms) + " ms)";
+            else if (reasm.duplicates() == 0)     why = "nenhum bloco duplicado chegou ao central";
+            else if (reasm.reordered() == 0)      why = "nenhum bloco fora de ordem chegou ao central";
+            if (!why.empty()) {
+                benchFailed(name, why + " (stream " + to_string(streamId) + ")");
+                failed = true;
+                break;
+            }
+            r.samples.push_back(chrono::duration<double, nano>(t1 - t0).count());
+            dups    += reasm.duplicates();
+            ooo     += reasm.reordered();
+            stalls  += total.stalls;
+            revives += total.revives;
+        }
+        if (failed) continue;
+        r.extra["duplicates"] = dups;
+        r.extra["reordered"]  = ooo;
+        r.extra["stalls"]     = stalls;
+        r.extra["revives"]    = revives;
+        out.push_back(r);
+    }
+}
+
+/**
+ * @brief Endereço 127.0.0.1:@p port no formato de resolveHost().
+ */
+ResolvedAddr loopbackAddr(uint16_t port) {
+    ResolvedAddr r{};
+    sockaddr_in& a = reinterpret_cast<sockaddr_in&>(r.addr);
+    a.sin_family      = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    a.sin_port        = htons(port);
+    r.len = sizeof(a);
+    return r;
+}
+
+/**
+ * @brief Happy Eyeballs: a resolução devolve primeiro um endereço que nunca
+ *        responde e depois o central. Cada amostra exige que o primeiro
+ *        receba CONNECT, que o central vença e que o tempo até conectado
+ *        fique perto de ATTEMPT_DELAY_MS (a segunda tentativa só sai depois
+ *        desse intervalo e o central responde logo).
+ */
+void benchHappyEyeballs(vector<Result>& out, const string& filter) {
+    const string name = "loopback/startup/happy_eyeballs";
+    if (name.find(filter) == string::npos) return;
+    const double MIN_MS = ATTEMPT_DELAY_MS * 0.9, MAX_MS = ATTEMPT_DELAY_MS + 150;
+
+    LoopbackCentral central;
+    int silent = socket(AF_INET, SOCK_DGRAM, 0);
+    ResolvedAddr dead = loopbackAddr(0);
+    socklen_t dl = dead.len;
+    if (!central.start() || silent < 0 || bind(silent, (sockaddr*)&dead.addr, dead.len) < 0
+        || getsockname(silent, (sockaddr*)&dead.addr, &dl) < 0) {
+        benchFailed(name, "não foi possível preparar os endereços em loopback");
+        if (silent >= 0) close(silent);
+        return;
+    }
+    vector<ResolvedAddr> addrs = {dead, loopbackAddr(central.getPort())};
+
+    Result r; r.name = name;
+    string why;
+    for (int i = 0; i < 20 && why.empty(); i++) {
+        UDPPeripheral p;
+        SlowBench::setResolved(p, addrs);
+        auto t0 = Clock::now();
+        bool ok = p.connect();
+        auto t1 = Clock::now();
+        double ms = chrono::duration<double, milli>(t1 - t0).count();
+
+        int tried = 0;
+        uint8_t junk[HDR_SIZE];
+        while (recv(silent, junk, sizeof(junk), MSG_DONTWAIT) > 0) tried++;
+
+        bool live = ok && SlowBench::serverPort(p) == central.getPort();
+        if (!ok)                             why = "não conectou";
+        else if (!live)                      why = "venceu o endereço que não responde";
+        else if (tried == 0)                 why = "o primeiro endereço não recebeu CONNECT";
+        else if (ms < MIN_MS || ms > MAX_MS) why = "conectou em " + to_string((int)ms) + " ms (esperado ~"
+                                                   + to_string(ATTEMPT_DELAY_MS) + " ms)";
+        else r.samples.push_back(chrono::duration<double, nano>(t1 - t0).count());
+    }
+    close(silent);
+    if (why.empty()) out.push_back(r);
+    else benchFailed(name, why);
+}
+
+/**
+ * @brief Tempo até conectado (resolução + handshake) com perda de 0, 5 e 20%
+ *        em cada sentido.
+ */
+void benchStartup(vector<Result>& out, const string& filter) {
+    benchHappyEyeballs(out, filter);
+
+    for (int pct : {0, 5, 20}) {
+        string name = "loopback/startup/loss=" + to_string(pct);
+        if (name.find(filter) == string::npos) continue;
+
+        LoopbackCentral central(16384, 0, pct / 100.0);
+        if (!central.start()) {
+            benchFailed(name, "não foi possível iniciar o central em loopback");
+            continue;
+        }
+        Result r; r.name = name;
+        bool ok = measureOps(r, 50, [&] {
+            UDPPeripheral p;
+            return p.init("127.0.0.1", central.getPort()) && p.connect();
+        }, [] {});
+        if (ok) out.push_back(r);
+        else benchFailed(name);
+    }
+}
+
+// ---------------------- JSON ----------------------
+
+/**
+ * @brief Resume as amostras de uma execução no formato gravado em JSON.
+ */
+Entry summarize(const Result& r) {
+    Entry e;
+    e.name = r.name;
+    double m = r.mean();
+    e.fields = {{"n", (double)r.samples.size()}, {"mean", m}, {"stddev", r.stddev()},
+                {"median", r.percentile(0.5)}, {"p99", r.percentile(0.99)},
+                {"min", r.percentile(0.0)}, {"max", r.percentile(1.0)}};
+    if (r.bytes > 0 && m > 0) {
+        e.fields.emplace_back("bytes", r.bytes);
+        e.fields.emplace_back("mbps", r.bytes * 8.0 * 1000.0 / m);
+    }
+    for (const auto& kv : r.extra) e.fields.push_back(kv);
+    e.runs.push_back(r.percentile(0.5));
+    return e;
+}
+
+void writeJson(ostream& os, const vector<Entry>& entries) {
+    os << "{\n  \"schema\": 2,\n  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n";
+    os << fixed;
+    for (size_t i = 0; i < entries.size(); i++) {
+        const Entry& e = entries[i];
+        os << "    {\"name\": \"" << e.name << "\"";
+        for (const auto& kv : e.fields) {
+            os << ", \"" << kv.first << "\": ";
+            if (kv.first == "n") os << (long long)kv.second;
+            else os << setprecision(kv.first == "mbps" ? 3 : 1) << kv.second;
+        }
+        os << ", \"runs\": [" << setprecision(1);
+        for (size_t k = 0; k < e.runs.size(); k++) os << (k ? ", " : "") << e.runs[k];
+        os << "]}" << (i + 1 < entries.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+/**
+ * @brief Lê uma linha de objeto gerada por writeJson: todos os pares
+ *        "chave": número e o vetor "runs" (ausente em JSON antigos).
+ */
+bool parseEntry(const string& line, Entry& e) {
+    size_t k = line.find("\"name\": \"");
+    if (k == string::npos) return false;
+    size_t b = k + 9, p = line.find('"', b);
+    if (p == string::npos) return false;
+    e.name = line.substr(b, p - b);
+
+    while ((p = line.find('"', p + 1)) != string::npos) {
+        size_t q = line.find('"', p + 1);
+        if (q == string::npos) break;
+        string key = line.substr(p + 1, q - p - 1);
+        size_t v = line.find_first_not_of(": ", q + 1);
+        if (v == string::npos) break;
+        const char* c = line.c_str() + v;
+        char* end;
+        if (*c == '[') {
+            for (c++; ; c = end) {
+                while (*c == ' ' || *c == ',') c++;
+                double x = strtod(c, &end);
+                if (end == c) break;
+                if (key == "runs") e.runs.push_back(x);
+            }
+        } else {
+            double x = strtod(c, &end);
+            if (end == c) { p = q; continue; }
+            e.fields.emplace_back(key, x);
+        }
+        p = (size_t)(end - line.c_str());
+    }
+    double m;
+    return e.field("median", m);
+}
+
+/**
+ * @brief Lê um JSON gerado por writeJson (um benchmark por linha).
+ * @return false se o arquivo não abre ou não tem nenhuma entrada válida
+ */
+bool readEntries(const string& path, vector<Entry>& out) {
+    ifstream in(path);
+    if (!in) return false;
+    string line;
+    while (getline(in, line)) {
+        Entry e;
+        if (parseEntry(line, e)) out.push_back(e);
+    }
+    return !out.empty();
+}
+
+/**
+ * @brief Roda a suíte em @p runs processos novos (cada um com seu próprio
+ *        layout de memória, caches e estado de CPU, que são a maior fonte de
+ *        variação entre execuções) e junta os resultados: por benchmark, os
+ *        campos vêm do processo de mediana central e `runs` guarda a mediana
+ *        de cada processo.
+ * @return false se algum processo não pôde ser executado
+ */
+bool runProcesses(const char* self, int runs, const string& filter, vector<Entry>& out) {
+    vector<string> order;
+    map<string, vector<Entry>> byName;
+
+    for (int r = 1; r <= runs; r++) {
+        char tmpl[] = "/tmp/slow_bench.XXXXXX";
+        int tfd = mkstemp(tmpl);
+        if (tfd < 0) return false;
+        close(tfd);
+
+        cerr << "[INFO] Execução " << r << "/" << runs << "\n";
+        pid_t pid = fork();
+        if (pid == 0) {
+            execlp(self, self, "--out", tmpl, "--filter", filter.c_str(), (char*)nullptr);
+            _exit(127);
+        }
+        int st = 0;
+        if (pid < 0 || waitpid(pid, &st, 0) < 0 || !WIFEXITED(st)
+            || (WEXITSTATUS(st) != 0 && WEXITSTATUS(st) != 2)) {
+            unlink(tmpl);
+            cerr << "[ERRO] Execução " << r << " não terminou normalmente\n";
+            return false;
+        }
+        if (WEXITSTATUS(st) == 2)
+            benchFailed("execução " + to_string(r), "algum benchmark falhou (veja acima)");
+
+        vector<Entry> entries;
+        readEntries(tmpl, entries);
+        unlink(tmpl);
+        for (const Entry& e : entries) {
+            if (!byName.count(e.name)) order.push_back(e.name);
+            byName[e.name].push_back(e);
+        }
+    }
+
+    for (const string& name : order) {
+        vector<Entry>& v = byName[name];
+        vector<double> medians;
+        for (const Entry& e : v) medians.push_back(e.runs.empty() ? 0 : e.runs[0]);
+        vector<Entry> sorted = v;
+        sort(sorted.begin(), sorted.end(),
+             [](const Entry& a, const Entry& b) { return a.runs[0] < b.runs[0]; });
+        Entry merged = sorted[(sorted.size() - 1) / 2];
+        merged.runs = medians;
+        out.push_back(merged);
+    }
+    return true;
+}
+
+/**
+ * @brief Compara a mediana das medianas por processo com o baseline.
+ *
+ * O ruído relevante é entre processos, não entre amostras de um processo,
+ * então cada benchmark tem seu próprio piso de ruído: a amplitude relativa
+ * das medianas por processo do baseline (máx/mín - 1). Regressão = mediana
+ * atual acima do pior processo do baseline por mais que max(@p threshold,
+ * ruído) e por pelo menos MIN_DELTA_NS. Benchmarks cujo baseline tem menos
+ * de MIN_RUNS processos são listados como não avaliados. Entradas do
+ * baseline (dentro de @p filter) ausentes nos resultados contam como falha.
+ * @param notGated Recebe o número de benchmarks não avaliados
+ * @return número de regressões e benchmarks ausentes
+ */
+int compare(const vector<Entry>& results, const map<string, Entry>& base,
+            double threshold, const string& filter, int& notGated) {
+    const size_t MIN_RUNS     = 3;   ///< Processos no baseline para avaliar um benchmark
+    const double MIN_DELTA_NS = 5.0; ///< Piora absoluta mínima (casos de poucos ns)
+    int regressions = 0;
+    notGated = 0;
+
+    cerr << "\n" << left << setw(40) << "benchmark" << right << setw(14) << "baseline"
+         << setw(14) << "atual" << setw(10) << "delta" << setw(9) << "ruído" << "\n";
+    for (const Entry& r : results) {
+        auto it = base.find(r.name);
+        if (it == base.end()) {
+            cerr << left << setw(40) << r.name << right << "  (novo, sem baseline)\n";
+            continue;
+        }
+        const Entry& b = it->second;
+        if (b.runs.size() < MIN_RUNS) {
+            notGated++;
+            cerr << left << setw(40) << r.name << right << "  NÃO AVALIADO (baseline com "
+                 << b.runs.size() << " processo(s), mínimo " << MIN_RUNS << ")\n";
+            continue;
+        }
+        double bMin = *min_element(b.runs.begin(), b.runs.end());
+        double bMax = *max_element(b.runs.begin(), b.runs.end());
+        double bMed = medianOf(b.runs), cur = medianOf(r.runs);
+        double noise = bMin > 0 ? bMax / bMin - 1 : 0;
+        double limit = std::max(bMax * (1 + std::max(threshold, noise)), bMax + MIN_DELTA_NS);
+        double delta = bMed > 0 ? (cur - bMed) / bMed : 0;
+        bool regressed = cur > limit;
+        if (regressed) regressions++;
+
+        cerr << left << setw(40) << r.name << right << fixed << setprecision(1)
+             << setw(14) << bMed << setw(14) << cur
+             << setw(9) << showpos << delta * 100 << "%" << noshowpos
+             << setw(8) << noise * 100 << "%"
+             << (regressed ? "  REGRESSÃO" : "") << "\n";
+    }
+
+    for (const auto& kv : base) {
+        if (kv.first.find(filter) == string::npos) continue;
+        bool found = any_of(results.begin(), results.end(),
+                            [&](const Entry& r) { return r.name == kv.first; });
+        if (found) continue;
+        regressions++;
+        cerr << left << setw(40) << kv.first << right << "  AUSENTE (está no baseline)\n";
+    }
+    return regressions;
+}
+
+void usage(const char* prog) {
+    cerr << "Uso: " << prog << " [--out ARQ] [--runs N] [--compare BASELINE] [--threshold FRAC] [--filter TEXTO]\n"
+         << "  --out ARQ          grava o JSON em ARQ (padrão: stdout)\n"
+         << "  --runs N           roda a suíte em N processos e grava a mediana de cada\n"
+         << "                     um (baselines precisam de N >= 3; padrão: 1)\n"
+         << "  --compare BASELINE compara com um JSON salvo; regressões e benchmarks\n"
+         << "                     ausentes fazem o programa sair com 2\n"
+         << "  --threshold FRAC   piora relativa mínima para regressão (padrão: 0.10)\n"
+         << "  --filter TEXTO     roda apenas benchmarks cujo nome contém TEXTO\n"
+         << "Qualquer benchmark que falhe também faz o programa sair com 2.\n";
+}
+
+int main(int argc, char** argv) {
+    string outPath, basePath, filter;
+    double threshold = 0.10;
+    int runs = 1;
+
+    for (int i = 1; i < argc; i++) {
+        string a = argv[i];
+        bool hasVal = i + 1 < argc;
+        if (a == "--out" && hasVal)            outPath = argv[++i];
+        else if (a == "--compare" && hasVal)   basePath = argv[++i];
+        else if (a == "--threshold" && hasVal) threshold = atof(argv[++i]);
+        else if (a == "--filter" && hasVal)    filter = argv[++i];
+        else if (a == "--runs" && hasVal)      runs = atoi(argv[++i]);
+        else { usage(argv[0]); return 1; }
+    }
+    if (runs < 1) { usage(argv[0]); return 1; }
+
+    map<string, Entry> base;
+    if (!basePath.empty()) {
+        vector<Entry> entries;
+        if (!readEntries(basePath, entries)) {
+            cerr << "[ERRO] Baseline " << basePath << " ilegível ou sem benchmarks\n";
+            return 1;
+        }
+        bool gated = false;
+        for (const Entry& e : entries) {
+            base[e.name] = e;
+            gated = gated || e.runs.size() >= 3;
+        }
+        if (!gated) {
+            cerr << "[ERRO] Baseline " << basePath << " não tem medianas de 3 ou mais processos;"
+                 << " gere-o com --runs (make bench-baseline)\n";
+            return 1;
+        }
+    }
+
+    vector<Entry> entries;
+    if (runs > 1) {
+        if (!runProcesses(argv[0], runs, filter, entries)) return 1;
+    } else {
+        vector<Result> results;
+        NullBuf nb;
+        streambuf* old = cout.rdbuf(&nb);
+        benchMicro(results, filter);
+        benchLoopback(results, filter);
+        benchStriped(results, filter);
+        benchFailover(results, filter);
+        benchStartup(results, filter);
+        cout.rdbuf(old);
+        for (const Result& r : results) entries.push_back(summarize(r));
+    }
+
+    if (outPath.empty()) {
+        writeJson(cout, entries);
+    } else {
+        ofstream of(outPath);
+        writeJson(of, entries);
+        cerr << "[OK] " << entries.size() << " benchmarks gravados em " << outPath << "\n";
+    }
+
+    int status = 0;
+    if (!basePath.empty()) {
+        int notGated = 0;
+        int reg = compare(entries, base, threshold, filter, notGated);
+        if (notGated > 0)
+            cerr << "[AVISO] " << notGated << " benchmark(s) não avaliados (baseline sem processos suficientes)\n";
+        if (reg > 0) {
+            cerr << "[ERRO] " << reg << " regressão(ões) significativa(s) ou benchmark(s) ausente(s)\n";
+            status = 2;
+        } else {
+            cerr << "[OK] Nenhuma regressão significativa\n";
+        }
+    }
+    if (!failures.empty()) {
+        cerr << "[ERRO] " << failures.size() << " benchmark(s) falharam\n";
+        status = 2;
+    }
+    return status;
+}
@@ -18,6 +18,16 @@ Cauê Paiva Lira - 14675416
 #include <algorithm>
 #include <cstdint> 
 #include <vector> 
+#include <chrono>
+#include <sys/uio.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <future>
+#include <poll.h>
 
 using namespace std;
 
@@ -155,6 +165,73 @@ void printHeader(const Header& h, const string& label) {
     cout << "FO: "      << (int)h.fo  << "\n\n";
 }
 
+// Limites padrão para o ajuste automático de SO_RCVBUF/SO_SNDBUF
+static const uint32_t SOCKBUF_MIN  = 64 * 1024;
+static const uint32_t SOCKBUF_MAX  = 4 * 1024 * 1024;
+// Custo aproximado de cada datagrama no buffer do kernel além do payload
+static const uint32_t PKT_OVERHEAD = 768;
+
+// Inicialização: Happy Eyeballs (RFC 8305) e retransmissão do CONNECT
+static const int CONNECT_RTO_MS      = 1000;  ///< RTO inicial do CONNECT (RFC 6298)
+static const int CONNECT_RTO_MAX_MS  = 2000;  ///< RTO máximo (dobra a cada perda)
+static const int ATTEMPT_DELAY_MS    = 250;   ///< Intervalo entre tentativas em endereços diferentes
+static const int CONNECT_TIMEOUT_MS  = 15000; ///< Prazo total do handshake (8 CONNECTs)
+
+// Envio em janela (sendNoWait/pumpAcks): RTO = 2 × RTT suavizado, com piso
+static const int DATA_RTO_MIN_MS     = 200;   ///< Menor RTO de um DATA em trânsito
+
+/**
+ * @struct ResolvedAddr
+ * @brief Endereço (IPv4 ou IPv6) retornado pelo getaddrinfo.
+ */
+struct ResolvedAddr {
+    sockaddr_storage addr;
+    socklen_t        len;
+};
+
+/**
+ * @brief Resolve host:port (IPv4 e IPv6) e intercala as famílias como
+ *        recomenda a RFC 8305, mantendo a ordem de preferência do sistema.
+ */
+vector<ResolvedAddr> resolveHost(const string& host, int port) {
+    addrinfo hints{};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags    = AI_ADDRCONFIG;
+
+    addrinfo* res = nullptr;
+    vector<ResolvedAddr> first, second;
+    if (getaddrinfo(host.c_str(), to_string(port).c_str(), &hints, &res) != 0 || !res)
+        return first;
+
+    int firstFamily = res->ai_family;
+    for (addrinfo* ai = res; ai; ai = ai->ai_next) {
+        ResolvedAddr ra{};
+        memcpy(&ra.addr, ai->ai_addr, ai->ai_addrlen);
+        ra.len = ai->ai_addrlen;
+        (ai->ai_family == firstFamily ? first : second).push_back(ra);
+    }
+    freeaddrinfo(res);
+
+    vector<ResolvedAddr> out;
+    for (size_t i = 0; i < std::max(first.size(), second.size()); i++) {
+        if (i < first.size())  out.push_back(first[i]);
+        if (i < second.size()) out.push_back(second[i]);
+    }
+    return out;
+}
+
+/**
+ * @struct LinkStats
+ * @brief Estatísticas do enlace usadas no dimensionamento dos buffers.
+ */
+struct LinkStats {
+    uint64_t kernelDrops  = 0; ///< Datagramas descartados pelo kernel (SO_RXQ_OVFL)
+    uint32_t srttUs       = 0; ///< RTT suavizado (µs)
+    int      rcvBuf       = 0; ///< SO_RCVBUF efetivo (valor reportado pelo kernel)
+    int      sndBuf       = 0; ///< SO_SNDBUF efetivo (valor reportado pelo kernel)
+};
+
 /**
  * @struct PendingPacket
  * @brief Representa um pacote pendente na fila de retransmissão.
@@ -164,9 +241,11 @@ struct PendingPacket {
     size_t   length;                      ///< Tamanho total do pacote
     uint32_t seq;                         ///< Número de sequência
     size_t   dataSize;                    ///< Tamanho dos dados (sem cabeçalho)
+    chrono::steady_clock::time_point sentAt; ///< Último envio (RTT e RTO)
+    int      tx = 1;                      ///< Quantas vezes já foi enviado
     
     PendingPacket(const uint8_t* buf, size_t len, uint32_t sequence, size_t dSize) 
-        : length(len), seq(sequence), dataSize(dSize) {
+        : length(len), seq(sequence), dataSize(dSize), sentAt(chrono::steady_clock::now()) {
         memcpy(buffer, buf, len);
     }
 };
@@ -178,13 +257,18 @@ struct PendingPacket {
 class UDPPeripheral {
 private:
     int        fd;              ///< File descriptor do socket
-    sockaddr_in srv;            ///< Endereço do servidor
+    sockaddr_storage srv{};     ///< Endereço do servidor (IPv4 ou IPv6)
+    socklen_t  srvLen = 0;      ///< Tamanho válido de srv
+    future<vector<ResolvedAddr>> resolving; ///< Resolução DNS em andamento
+    vector<ResolvedAddr> resolved;         ///< Endereços já resolvidos (reusados em novo connect)
     Header     lastHdr;         ///< Último header armazenado
     Header     prevHdr;         ///< Header da última troca bem-sucedida
     bool       active    = false; ///< Conexão ativa?
     bool       hasPrev   = false; ///< Replay possível?
     uint32_t   nextSeq   = 0;     ///< Próximo sequence number
     uint32_t   lastCentralSeq = 0;///< Último seq do servidor
+    uint32_t   connectSeq = 0;    ///< seq do CONNECT (identifica SETUPs duplicados)
+    SID        sessionSid = SID::nil(); ///< SID atribuído pelo SETUP vencedor
     
     // Estados salvos para revive (capturados no disconnect)
     uint32_t   savedNextSeq = 0;     ///< nextSeq correto para revive
@@ -195,20 +279,201 @@ private:
     vector<PendingPacket> pendingQueue; ///< Fila de pacotes pendentes
     static const int MAX_RETRIES = 3; ///< Máximo de tentativas de retransmissão
 
+    LinkStats  linkStats;                    ///< RTT, vazão, buffers e descartes
+    uint32_t   sockBufMin  = SOCKBUF_MIN;    ///< Limite inferior dos buffers do socket
+    uint32_t   sockBufMax  = SOCKBUF_MAX;    ///< Limite superior dos buffers do socket
+    uint32_t   tunedBuf    = 0;              ///< Último tamanho pedido ao kernel
+    uint32_t   lastDropCounter = 0;          ///< Último contador SO_RXQ_OVFL visto
+    uint32_t   dropCap     = UINT32_MAX;     ///< Teto da janela anunciada após descartes
+    uint32_t   dropFloor   = 0;              ///< Piso dos buffers elevado após descartes
+    int        reviveAttempt = 0;            ///< Tentativas do revive em curso
+
+    friend struct SlowBench;      ///< Benchmarks (slow_bench.cpp) acessam internos
+
+    /**
+     * @brief Tamanho do próximo fragmento: limitado por DATA_MAX e pelo
+     *        espaço livre da janela remota (0 se a janela estiver cheia).
+     */
+    size_t fragmentSize(size_t remaining) const {
+        size_t available = (window_size > bytesInFlight) ? (window_size - bytesInFlight) : 0;
+        return std::min({remaining, (size_t)DATA_MAX, available});
+    }
+
     uint16_t advertisedWindow() const {
         uint32_t livre = (window_size > bytesInFlight)
                         ? (window_size - bytesInFlight)
                         : 0;
+        // Não anuncia mais do que o buffer do kernel comporta (o valor
+        // reportado é o dobro do pedido; metade fica para payload) nem
+        // além do teto imposto após descartes
+        livre = std::min(livre, dropCap);
+        if (linkStats.rcvBuf > 0)
+            livre = std::min<uint32_t>(livre, linkStats.rcvBuf / 2);
         return static_cast<uint16_t>(std::min<uint32_t>(livre, UINT16_MAX));
     }
 
+    /**
+     * @brief Dimensiona SO_RCVBUF/SO_SNDBUF pela janela negociada (mais o
+     *        custo por datagrama no kernel), dentro de [sockBufMin, sockBufMax].
+     *        A janela já limita os bytes em trânsito e, portanto, o produto
+     *        banda-atraso alcançável; descartes elevam o piso (dropFloor).
+     *        Só chama o kernel quando o alvo muda mais de 25%.
+     */
+    void tuneSocketBuffers() {
+        if (fd < 0) return;
+        uint64_t pkts     = window_size / DATA_MAX + 1;
+        uint64_t wndBytes = window_size + pkts * (HDR_SIZE + PKT_OVERHEAD);
+        uint64_t target   = std::max<uint64_t>(2 * wndBytes, dropFloor);
+        target = std::min<uint64_t>(std::max<uint64_t>(target, sockBufMin), sockBufMax);
+
+        if (tunedBuf && target * 4 >= (uint64_t)tunedBuf * 3 && target * 4 <= (uint64_t)tunedBuf * 5)
+            return;
+
+        int v = (int)target;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &v, sizeof(v));
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &v, sizeof(v));
+        tunedBuf = (uint32_t)target;
+
+        socklen_t l = sizeof(int);
+        getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &linkStats.rcvBuf, &l);
+        l = sizeof(int);
+        getsockopt(fd, SOL_SOCKET, SO_SNDBUF, &linkStats.sndBuf, &l);
+    }
+
+    /**
+     * @brief Registra o contador cumulativo de descartes do kernel. Cada
+     *        novo descarte corta pela metade o teto da janela anunciada e
+     *        tenta aumentar os buffers; recepções limpas o recuperam aos poucos.
+     */
+    void noteKernelDrops(uint32_t total) {
+        uint32_t delta = total - lastDropCounter;
+        if (delta == 0) {
+            if (dropCap != UINT32_MAX)
+                dropCap = (dropCap > UINT32_MAX - DATA_MAX) ? UINT32_MAX : dropCap + DATA_MAX;
+            return;
+        }
+        lastDropCounter = total;
+        linkStats.kernelDrops += delta;
+        uint32_t base = std::min<uint32_t>(dropCap, std::max<uint32_t>(window_size, DATA_MAX));
+        dropCap = std::max<uint32_t>(base / 2, DATA_MAX);
+        dropFloor = (uint32_t)std::min<uint64_t>((uint64_t)std::max(tunedBuf, sockBufMin) * 2, sockBufMax);
+        tuneSocketBuffers();
+    }
+
+    /**
+     * @brief Atualiza o RTT suavizado (EWMA 1/8, como no TCP) a partir de uma
+     *        troca DATA→ACK. Só recebe amostras de pacotes enviados uma única
+     *        vez (regra de Karn): o ACK de um retransmitido é ambíguo.
+     */
+    void noteRttSample(chrono::steady_clock::duration rtt) {
+        uint32_t us = (uint32_t)std::max<int64_t>(1,
+                        chrono::duration_cast<chrono::microseconds>(rtt).count());
+        linkStats.srttUs = linkStats.srttUs ? (7 * linkStats.srttUs + us) / 8 : us;
+    }
+
+    /**
+     * @brief Zera o estado de descartes e buffers ao trocar de socket: o
+     *        contador SO_RXQ_OVFL e os tamanhos pertencem ao socket anterior.
+     */
+    void resetDropState() {
+        lastDropCounter = 0;
+        dropCap         = UINT32_MAX;
+        dropFloor       = 0;
+        tunedBuf        = 0;
+    }
+
+    /**
+     * @brief Recebe um datagrama e lê o contador SO_RXQ_OVFL dos dados auxiliares.
+     * @param sock Socket a ler (-1 = socket da sessão). Sockets de tentativas
+     *             de conexão não entram na contagem de descartes da sessão.
+     * @return bytes recebidos ou -1 em erro/timeout
+     */
+    ssize_t recvPacket(uint8_t* buf, size_t len, int sock = -1) {
+        sockaddr_storage sa;
+        iovec iov{buf, len};
+        alignas(cmsghdr) char ctrl[CMSG_SPACE(sizeof(uint32_t))];
+        msghdr msg{};
+        msg.msg_name       = &sa;
+        msg.msg_namelen    = sizeof(sa);
+        msg.msg_iov        = &iov;
+        msg.msg_iovlen     = 1;
+        msg.msg_control    = ctrl;
+        msg.msg_controllen = sizeof(ctrl);
+
+        ssize_t n = recvmsg(sock < 0 ? fd : sock, &msg, 0);
+        if (n < 0 || sock >= 0) return n;
+
+        uint32_t total = lastDropCounter;
+#ifdef SO_RXQ_OVFL
+        for (cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SO_RXQ_OVFL)
+                memcpy(&total, CMSG_DATA(c), sizeof(total));
+        }
+#endif
+        noteKernelDrops(total);
+        return n;
+    }
+
+    /**
+     * @brief Pacote que não pertence à sessão atual: SID diferente ou SETUP
+     *        duplicado (resposta atrasada a um CONNECT retransmitido).
+     */
+    bool isStale(const Header& r) const {
+        bool setup = (r.sf & FLAG_AR) && !(r.sf & FLAG_ACK) && r.ack == connectSeq;
+        return setup || !r.sid.isEqual(sessionSid);
+    }
+
+    /**
+     * @brief Espera até @p timeoutMs por um datagrama da sessão, descartando
+     *        os que isStale() rejeita sem consumir o prazo de quem chamou.
+     * @param r Header desserializado do datagrama aceito
+     * @return bytes recebidos ou -1 em timeout/erro
+     */
+    ssize_t recvSession(uint8_t* buf, size_t len, Header& r, int timeoutMs) {
+        auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+        while (true) {
+            int left = (int)chrono::duration_cast<chrono::milliseconds>(
+                           deadline - chrono::steady_clock::now()).count();
+            if (left < 0) return -1;
+            pollfd pfd{fd, POLLIN, 0};
+            if (poll(&pfd, 1, left) <= 0) return -1;
+
+            ssize_t n = recvPacket(buf, len);
+            if (n < HDR_SIZE) continue;
+            deserialize(r, buf);
+            if (isStale(r)) {
+                cout << "[INFO] Ignorando pacote fora da sessão (SETUP duplicado ou SID diferente)\n";
+                continue;
+            }
+            return n;
+        }
+    }
+
+    /**
+     * @brief Cria um socket UDP da família dada com as opções da sessão.
+     * @return descritor ou -1
+     */
+    int openSocket(int family) {
+        int s = socket(family, SOCK_DGRAM, 0);
+        if (s < 0) return -1;
+        timeval tv{5,0};
+        setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+#ifdef SO_RXQ_OVFL
+        int one = 1;
+        setsockopt(s, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one));
+#endif
+        return s;
+    }
+
     /**
      * @brief Remove pacotes da fila com seq <= acknum e atualiza bytesInFlight.
+     * @param removed Se não nulo, recebe os seq removidos
      */
-    void removePendingPackets(uint32_t acknum) {
+    void removePendingPackets(uint32_t acknum, vector<uint32_t>* removed = nullptr) {
         auto it = pendingQueue.begin();
         while (it != pendingQueue.end()) {
             if (it->seq <= acknum) {
+                if (removed) removed->push_back(it->seq);
                 bytesInFlight -= it->dataSize;
                 it = pendingQueue.erase(it);
             } else {
@@ -236,37 +501,22 @@ private:
                 return false;
             }
 
-            if (sendto(fd, buf, len, 0, (sockaddr*)&srv, sizeof(srv)) < 0) {
+            auto sentAt = chrono::steady_clock::now();
+            if (sendto(fd, buf, len, 0, (sockaddr*)&srv, srvLen) < 0) {
                 continue;
             }
 
-            fd_set readfds;
-            struct timeval timeout;
-            FD_ZERO(&readfds);
-            FD_SET(fd, &readfds);
-            timeout.tv_sec = 2;
-            timeout.tv_usec = 0;
-
-            int result = select(fd + 1, &readfds, nullptr, nullptr, &timeout);
-            
-            if (result > 0 && FD_ISSET(fd, &readfds)) {
-                uint8_t rbuf[HDR_SIZE];
-                sockaddr_in sa;
-                socklen_t sl = sizeof(sa);
-                ssize_t recv_len = recvfrom(fd, rbuf, HDR_SIZE, 0, (sockaddr*)&sa, &sl);
-                
-                if (recv_len >= HDR_SIZE) {
-                    Header r;
-                    deserialize(r, rbuf);
-                    
-                    if (r.sf & FLAG_ACK) {
-                        removePendingPackets(r.ack);
-                        lastCentralSeq = r.seq;
-                        prevHdr = r;
-                        window_size = r.wnd;
-                        return true;
-                    }
-                }
+            uint8_t rbuf[HDR_SIZE];
+            Header r;
+            if (recvSession(rbuf, HDR_SIZE, r, 2000) >= HDR_SIZE && (r.sf & FLAG_ACK)) {
+                if (attempt == 1) // regra de Karn
+                    noteRttSample(chrono::steady_clock::now() - sentAt);
+                removePendingPackets(r.ack);
+                lastCentralSeq = r.seq;
+                prevHdr = r;
+                window_size = r.wnd;
+                tuneSocketBuffers();
+                return true;
             }
         }
 
@@ -280,52 +530,129 @@ public:
     ~UDPPeripheral() { if (fd >= 0) close(fd); }
 
     /**
-     * @brief Inicializa socket e configuração do servidor.
+     * @brief Inicia a resolução do servidor em segundo plano (IPv4 e IPv6).
+     *        O socket é criado em connect(), na família do endereço vencedor.
+     *        Quem abre várias sessões deve chamar init() em todas antes do
+     *        primeiro connect() para que as resoluções corram em paralelo.
      * @param host IP ou hostname
      * @param port Porta UDP
-     * @return true em sucesso, false caso contrário
+     * @return true se a resolução foi iniciada
      */
     bool init(const char* host, int port) {
-        if ((fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) return false;
-        hostent* he = gethostbyname(host);
-        if (!he) return false;
-        memset(&srv, 0, sizeof(srv));
-        srv.sin_family = AF_INET;
-        memcpy(&srv.sin_addr, he->h_addr, he->h_length);
-        srv.sin_port = htons(port);
-        timeval tv{5,0};
-        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        if (!host || port <= 0 || port > 65535) return false;
+        resolving = async(launch::async, resolveHost, string(host), port);
         return true;
     }
 
     /**
      * @brief Realiza handshake inicial com o servidor (3-way handshake).
+     *
+     * Dispara CONNECT para cada endereço resolvido, um a cada
+     * ATTEMPT_DELAY_MS (Happy Eyeballs); cada tentativa retransmite com RTO
+     * inicial de CONNECT_RTO_MS, dobrando até CONNECT_RTO_MAX_MS. O primeiro
+     * SETUP válido vence, os demais sockets são fechados e SETUPs
+     * duplicados pendentes no socket vencedor são descartados. Os endereços
+     * resolvidos ficam guardados: um novo connect() não exige outro init().
      */
     bool connect() {
+        if (resolving.valid()) resolved = resolving.get();
+        const vector<ResolvedAddr>& addrs = resolved;
+        if (addrs.empty()) return false;
 
-        // PASSO 1: Envia CONNECT
+        // PASSO 1: Envia CONNECT (mesmo seq em todas as tentativas)
         Header h;
         h.seq = nextSeq++;
         h.wnd = advertisedWindow(); // janela atual
         h.sf |= FLAG_C; // flag connect
+        connectSeq = h.seq;
 
         uint8_t buf[HDR_SIZE];
         serialize(h, buf);
         printHeader(h, "Enviado - CONNECT (1/3)");
-        if (sendto(fd, buf, HDR_SIZE, 0, (sockaddr*)&srv, sizeof(srv)) < HDR_SIZE)
-            return false; 
-
-        // PASSO 2: Aguarda SETUP do servidor
-        uint8_t rbuf[HDR_SIZE + DATA_MAX];
-        sockaddr_in sa; socklen_t sl = sizeof(sa);
-        if (recvfrom(fd, rbuf, sizeof(rbuf), 0, (sockaddr*)&sa, &sl) < HDR_SIZE)
-            return false;
 
+        struct Attempt {
+            int                      sock;
+            size_t                   addr;  ///< Índice em addrs
+            chrono::milliseconds     rto;
+            chrono::steady_clock::time_point nextTx;
+            int                      sent;  ///< CONNECTs enviados
+        };
+        vector<Attempt> attempts;
+        auto now       = chrono::steady_clock::now();
+        auto deadline  = now + chrono::milliseconds(CONNECT_TIMEOUT_MS);
+        auto nextStart = now;
+        size_t nextAddr = 0;
+
+        // PASSO 2: Aguarda SETUP do servidor em qualquer tentativa
+        int winner = -1;
         Header r;
-        deserialize(r, rbuf);
-        printHeader(r, "Recebido - SETUP (2/3)");
+        while (winner < 0 && (now = chrono::steady_clock::now()) < deadline) {
+            // Nova tentativa se o atraso passou ou se nenhuma está ativa
+            if (nextAddr < addrs.size() && (now >= nextStart || attempts.empty())) {
+                const ResolvedAddr& a = addrs[nextAddr];
+                int sck = openSocket(a.addr.ss_family);
+                if (sck >= 0) {
+                    attempts.push_back({sck, nextAddr, chrono::milliseconds(CONNECT_RTO_MS), now, 0});
+                }
+                nextAddr++;
+                nextStart = now + chrono::milliseconds(ATTEMPT_DELAY_MS);
+            }
+
+            // Envia/retransmite CONNECT nas tentativas cujo RTO venceu
+            for (Attempt& at : attempts) {
+                if (now < at.nextTx) continue;
+                const ResolvedAddr& a = addrs[at.addr];
+                if (at.sent++ > 0) {
+                    at.rto = std::min(at.rto * 2, chrono::milliseconds(CONNECT_RTO_MAX_MS));
+                    cout << "[INFO] Retransmitindo CONNECT (tentativa " << at.sent << ")\n";
+                }
+                sendto(at.sock, buf, HDR_SIZE, 0, (const sockaddr*)&a.addr, a.len);
+                at.nextTx = now + at.rto;
+            }
+            if (attempts.empty()) {
+                if (nextAddr >= addrs.size()) break; // nenhum socket pôde ser criado
+                continue;
+            }
+
+            // Espera até o próximo evento: SETUP, RTO ou nova tentativa
+            auto wake = deadline;
+            for (const Attempt& at : attempts) wake = std::min(wake, at.nextTx);
+            if (nextAddr < addrs.size()) wake = std::min(wake, nextStart);
+            int timeout = (int)std::max<int64_t>(0,
+                chrono::duration_cast<chrono::milliseconds>(wake - now).count());
+
+            vector<pollfd> pfds;
+            for (const Attempt& at : attempts) pfds.push_back({at.sock, POLLIN, 0});
+            if (poll(pfds.data(), pfds.size(), timeout) <= 0) continue;
+
+            for (size_t k = 0; k < pfds.size() && winner < 0; k++) {
+                if (!(pfds[k].revents & POLLIN)) continue;
+                uint8_t rbuf[HDR_SIZE + DATA_MAX];
+                if (recvPacket(rbuf, sizeof(rbuf), attempts[k].sock) < HDR_SIZE) continue;
+                deserialize(r, rbuf);
+                if (r.ack == h.seq && (r.sf & FLAG_AR)) // ACK confirma nosso CONNECT
+                    winner = (int)k;
+            }
+        }
+
+        if (winner >= 0) {
+            if (fd >= 0) close(fd);
+            fd = attempts[winner].sock;
+            memcpy(&srv, &addrs[attempts[winner].addr].addr, addrs[attempts[winner].addr].len);
+            srvLen = addrs[attempts[winner].addr].len;
+            resetDropState();
+            sessionSid = r.sid;
+
+            // Descarta SETUPs duplicados já enfileirados; os que chegarem
+            // depois são filtrados por isStale() em recvSession()
+            uint8_t junk[HDR_SIZE + DATA_MAX];
+            while (recv(fd, junk, sizeof(junk), MSG_DONTWAIT) > 0) {}
+        }
+        for (size_t k = 0; k < attempts.size(); k++)
+            if ((int)k != winner) close(attempts[k].sock);
+        if (winner < 0) return false;
 
-        if (r.ack != h.seq || !(r.sf & FLAG_AR)) return false; // verifica se ACK confirma nosso CONNECT
+        printHeader(r, "Recebido - SETUP (2/3)");
         
         // PASSO 3: Envia ACK final para completar 3-way handshake
         Header ack_final;
@@ -338,7 +665,7 @@ public:
         uint8_t ack_buf[HDR_SIZE];
         serialize(ack_final, ack_buf);
         printHeader(ack_final, "Enviado - ACK (3/3)");
-        if (sendto(fd, ack_buf, HDR_SIZE, 0, (sockaddr*)&srv, sizeof(srv)) < HDR_SIZE)
+        if (sendto(fd, ack_buf, HDR_SIZE, 0, (sockaddr*)&srv, srvLen) < HDR_SIZE)
             return false;
 
         // ajusta estado interno
@@ -349,6 +676,7 @@ public:
         window_size = r.wnd; // tamanho da janela do servidor
         bytesInFlight = 0;
         pendingQueue.clear();
+        tuneSocketBuffers(); // janela negociada: redimensiona buffers
 
         return true; // 3-way handshake bem sucedido
     }
@@ -370,16 +698,14 @@ public:
         serialize(h, buf);
         printHeader(h, "Pacote Enviado (DISCONNECT)");
 
-        if (sendto(fd, buf, HDR_SIZE, 0, (sockaddr*)&srv, sizeof(srv)) < HDR_SIZE)
+        if (sendto(fd, buf, HDR_SIZE, 0, (sockaddr*)&srv, srvLen) < HDR_SIZE)
             return false;
 
         const int MAX_TRIES = 3;
         for (int i = 1; i <= MAX_TRIES; ++i) {
             uint8_t rbuf[HDR_SIZE];
-            sockaddr_in sa; socklen_t sl = sizeof(sa);
-            ssize_t rec = recvfrom(fd, rbuf, HDR_SIZE, 0, (sockaddr*)&sa, &sl);
-            if (rec >= HDR_SIZE) {
-                Header rr; deserialize(rr, rbuf);
+            Header rr;
+            if (recvSession(rbuf, HDR_SIZE, rr, 5000) >= HDR_SIZE) {
                 printHeader(rr, "Pacote Recebido (DISCONNECT)");
                 if (rr.sf & FLAG_ACK) {
                     // Salva o estado correto para revive futuro
@@ -444,35 +770,18 @@ public:
                 
                 while (available < maxChunk) {
                     if (!pendingQueue.empty()) {
-                        fd_set readfds;
-                        struct timeval timeout;
-                        FD_ZERO(&readfds);
-                        FD_SET(fd, &readfds);
-                        timeout.tv_sec = 5;
-                        timeout.tv_usec = 0;
-
-                        int result = select(fd + 1, &readfds, nullptr, nullptr, &timeout);
-                        
-                        if (result > 0 && FD_ISSET(fd, &readfds)) {
-                            uint8_t rbuf[HDR_SIZE];
-                            sockaddr_in sa;
-                            socklen_t sl = sizeof(sa);
-                            ssize_t recv_len = recvfrom(fd, rbuf, HDR_SIZE, 0, (sockaddr*)&sa, &sl);
-                            
-                            if (recv_len >= HDR_SIZE) {
-                                Header r;
-                                deserialize(r, rbuf);
-                                
-                                if (r.sf & FLAG_ACK) {
-                                    removePendingPackets(r.ack);
-                                    lastCentralSeq = r.seq;
-                                    prevHdr = r;
-                                    window_size = r.wnd;
-                                    available = (window_size > bytesInFlight) ? (window_size - bytesInFlight) : 0;
-                                }
-                            }
-                        } else {
+                        uint8_t rbuf[HDR_SIZE];
+                        Header r;
+                        if (recvSession(rbuf, HDR_SIZE, r, 5000) < HDR_SIZE)
                             return false;
+
+                        if (r.sf & FLAG_ACK) {
+                            removePendingPackets(r.ack);
+                            lastCentralSeq = r.seq;
+                            prevHdr = r;
+                            window_size = r.wnd;
+                            tuneSocketBuffers();
+                            available = (window_size > bytesInFlight) ? (window_size - bytesInFlight) : 0;
                         }
                     } else {
                         if (available == 0) {
@@ -483,7 +792,7 @@ public:
                     }
                 }
                 
-                size_t chunk = std::min(maxChunk, available);
+                size_t chunk = fragmentSize(remaining);
                 bool more = (off + chunk < msg.size());
                 
                 if (!enviaFragmento(msg.data() + off, chunk, fid, fo++, more)) {
@@ -505,6 +814,101 @@ public:
     }
 
 
+    /**
+     * @brief Envia um DATA sem esperar o ACK (janela deslizante). O pacote
+     *        fica em pendingQueue até pumpAcks() vê-lo confirmado. Com nada
+     *        em trânsito, um pacote é aceito mesmo maior que a janela livre.
+     * @param seq Recebe o número de sequência usado
+     * @return false se inativo, payload maior que DATA_MAX ou janela cheia
+     */
+    bool sendNoWait(const string& payload, uint32_t& seq) {
+        if (!active || payload.size() > DATA_MAX) return false;
+        if (!pendingQueue.empty() && payload.size() > freeWindow()) return false;
+
+        Header h = prevHdr;
+        h.seq = nextSeq++;
+        h.ack = lastCentralSeq;
+        h.wnd = advertisedWindow();
+        h.sf  = (h.sf & ~0x1F) | FLAG_ACK;
+        h.fid = 0;
+        h.fo  = 0;
+
+        uint8_t buf[HDR_SIZE + DATA_MAX];
+        serialize(h, buf);
+        memcpy(buf + HDR_SIZE, payload.data(), payload.size());
+
+        // Uma falha no sendto é tratada como perda: o RTO reenvia
+        sendto(fd, buf, HDR_SIZE + payload.size(), 0, (sockaddr*)&srv, srvLen);
+        pendingQueue.emplace_back(buf, HDR_SIZE + payload.size(), h.seq, payload.size());
+        bytesInFlight += payload.size();
+        seq = h.seq;
+        return true;
+    }
+
+    /**
+     * @brief Processa ACKs e retransmite o que venceu o RTO.
+     *
+     * Espera até @p timeoutMs pelo primeiro ACK e depois consome, sem
+     * bloquear, os que já estiverem no socket. O RTO é 2 × RTT suavizado
+     * (mínimo DATA_RTO_MIN_MS; CONNECT_RTO_MS sem amostra) e dobra a cada
+     * reenvio; amostras de RTT seguem a regra de Karn.
+     * @param acked Recebe os seq confirmados
+     * @return false se algum pacote esgotou MAX_RETRIES (sessão travada)
+     */
+    bool pumpAcks(int timeoutMs, vector<uint32_t>& acked) {
+        uint8_t rbuf[HDR_SIZE + DATA_MAX];
+        Header r;
+        int wait = timeoutMs;
+        bool got = false;
+        while (recvSession(rbuf, sizeof(rbuf), r, wait) >= HDR_SIZE) {
+            wait = 0;
+            if (!(r.sf & FLAG_ACK)) continue;
+            auto now = chrono::steady_clock::now();
+            for (const PendingPacket& pk : pendingQueue)
+                if (pk.seq == r.ack && pk.tx == 1) noteRttSample(now - pk.sentAt);
+            removePendingPackets(r.ack, &acked);
+            lastCentralSeq = r.seq;
+            prevHdr = r;
+            window_size = r.wnd;
+            got = true;
+        }
+        if (got) tuneSocketBuffers();
+
+        auto now = chrono::steady_clock::now();
+        chrono::milliseconds rto(linkStats.srttUs
+                                 ? std::max<int64_t>(DATA_RTO_MIN_MS, 2 * linkStats.srttUs / 1000)
+                                 : CONNECT_RTO_MS);
+        for (PendingPacket& pk : pendingQueue) {
+            if (now - pk.sentAt < rto * (1 << (pk.tx - 1))) continue;
+            if (pk.tx >= MAX_RETRIES) return false;
+            sendto(fd, pk.buffer, pk.length, 0, (sockaddr*)&srv, srvLen);
+            pk.sentAt = now;
+            pk.tx++;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Abandona tudo o que está em trânsito (após um stall); quem
+     *        chamou sendNoWait() sabe quais seq reenviar por outro caminho.
+     */
+    void dropPending() {
+        pendingQueue.clear();
+        bytesInFlight = 0;
+    }
+
+    /**
+     * @brief Espaço livre na janela remota (bytes).
+     */
+    size_t freeWindow() const {
+        return (window_size > bytesInFlight) ? (window_size - bytesInFlight) : 0;
+    }
+
+    /**
+     * @brief Bytes enviados e ainda não confirmados.
+     */
+    uint32_t inFlight() const { return bytesInFlight; }
+
     /**
      * @brief Armazena sessão atual para revive futuro.
      */
@@ -522,14 +926,30 @@ public:
      */
     bool canRevive() const { return hasPrev; }
 
+    /**
+     * @brief Estatísticas do enlace (RTT, vazão, buffers, descartes do kernel).
+     */
+    const LinkStats& stats() const { return linkStats; }
+
+    /**
+     * @brief Define os limites do ajuste automático dos buffers do socket.
+     */
+    void setSocketBufferLimits(uint32_t minBytes, uint32_t maxBytes) {
+        sockBufMin = std::min(minBytes, maxBytes);
+        sockBufMax = maxBytes;
+        tunedBuf   = 0;
+        tuneSocketBuffers();
+    }
+
     /**
      * @brief Retoma sessão sem handshake completo (zero-way).
+     * @param timeoutMs Espera máxima pela resposta ao REVIVE; datagramas
+     *        que não confirmam o REVIVE (ACKs atrasados de antes) são ignorados
      */
-    bool zeroWay(const string& msg) {
+    bool zeroWay(const string& msg, int timeoutMs = 5000) {
         if (!hasPrev) return false;
 
-        static int revive_attempt = 0;
-        revive_attempt++;
+        reviveAttempt++;
 
         Header h = lastHdr;
         h.seq = savedNextSeq;        // Usa o seq correto salvo no disconnect
@@ -541,23 +961,28 @@ public:
         serialize(h, buf);
         memcpy(buf + HDR_SIZE, msg.data(), msg.size());
 
-        if (sendto(fd, buf, HDR_SIZE + msg.size(), 0, (sockaddr*)&srv, sizeof(srv)) < 0)
+        if (sendto(fd, buf, HDR_SIZE + msg.size(), 0, (sockaddr*)&srv, srvLen) < 0)
             return false;
 
         uint8_t rbuf[HDR_SIZE + DATA_MAX];
-        sockaddr_in sa; socklen_t sl = sizeof(sa);
-        if (recvfrom(fd, rbuf, sizeof(rbuf), 0, (sockaddr*)&sa, &sl) < HDR_SIZE)
-            return false;
-
         Header r;
-        deserialize(r, rbuf);
+        auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+        do {
+            int left = (int)chrono::duration_cast<chrono::milliseconds>(
+                           deadline - chrono::steady_clock::now()).count();
+            if (left < 0 || recvSession(rbuf, sizeof(rbuf), r, left) < HDR_SIZE) {
+                reviveAttempt = 0;
+                return false;
+            }
+        } while (r.ack != h.seq);
 
         if (!(r.sf & FLAG_AR)) {
             // Se é a primeira tentativa, tenta novamente
-            if (revive_attempt == 1) {
+            if (reviveAttempt == 1) {
                 usleep(200000); // 200ms de delay
-                return zeroWay(msg); // retry automático - uma única vez
+                return zeroWay(msg, timeoutMs); // retry automático - uma única vez
             }
+            reviveAttempt = 0;
             return false;
         }
 
@@ -567,13 +992,330 @@ public:
         nextSeq        = savedNextSeq + 1; // próximo após o seq usado no revive
         bytesInFlight  = 0;
         pendingQueue.clear();
-        revive_attempt = 0;
+        reviveAttempt  = 0;
+        return true;
+    }
+};
+
+// ---------------------- Striping em múltiplas sessões ----------------------
+
+// Metadados no início de cada payload striped: streamId | índice | total
+static const int STRIPE_HDR   = 12;
+static const int STRIPE_CHUNK = DATA_MAX - STRIPE_HDR; ///< Dados por bloco (1 datagrama)
+static const uint32_t STRIPE_MAX_CHUNKS = 1u << 22;   ///< Maior stream aceito (~5,6 GB)
+static const uint32_t STRIPE_MAX_GAP    = 4096;       ///< Blocos à frente de `next` guardados (~5,6 MB)
+
+/**
+ * @brief Monta o payload de um bloco: cabeçalho de stripe + dados.
+ */
+string packStripe(uint32_t streamId, uint32_t index, uint32_t count, const char* data, size_t len) {
+    string out(STRIPE_HDR + len, '\0');
+    uint8_t* p = reinterpret_cast<uint8_t*>(&out[0]);
+    pack32(streamId, p);
+    pack32(index,    p + 4);
+    pack32(count,    p + 8);
+    memcpy(p + STRIPE_HDR, data, len);
+    return out;
+}
+
+/**
+ * @class StripeReassembler
+ * @brief Lado receptor: recoloca em ordem os blocos de um stream striped.
+ *
+ * A memória é limitada: `count` não passa de STRIPE_MAX_CHUNKS e só são
+ * guardados blocos até `maxGap` posições à frente do próximo esperado. Um
+ * bloco recusado não deve ser confirmado, para que o emissor o reenvie.
+ */
+class StripeReassembler {
+private:
+    uint32_t            streamId;
+    uint32_t            maxGap;
+    uint32_t            count = 0;    ///< Total de blocos (0 = desconhecido)
+    uint32_t            next  = 0;    ///< Próximo índice esperado
+    map<uint32_t, string> pending;    ///< Blocos fora de ordem
+    string              out;          ///< Bytes já em ordem
+    uint64_t            dups  = 0;    ///< Blocos recebidos mais de uma vez
+    uint64_t            ooo   = 0;    ///< Blocos que chegaram antes de um anterior
+
+public:
+    explicit StripeReassembler(uint32_t id, uint32_t gap = STRIPE_MAX_GAP)
+        : streamId(id), maxGap(std::max<uint32_t>(gap, 1)) {}
+
+    /**
+     * @brief Aceita um payload recebido em qualquer sessão.
+     * @return false se não pertence a este stream, é inválido ou está longe
+     *         demais de `next` (nesse caso deve ser reenviado depois)
+     */
+    bool accept(const uint8_t* data, size_t len) {
+        if (len < (size_t)STRIPE_HDR || unpack32(data) != streamId) return false;
+        uint32_t idx = unpack32(data + 4), cnt = unpack32(data + 8);
+        if (cnt > STRIPE_MAX_CHUNKS || idx >= cnt || (count && cnt != count)) return false;
+        if (idx >= next && idx - next >= maxGap) return false;
+        count = cnt;
+        if (idx < next || pending.count(idx)) {
+            dups++;
+            return true;
+        }
+        if (idx > next) ooo++;
+        pending.emplace(idx, string((const char*)data + STRIPE_HDR, len - STRIPE_HDR));
+        for (auto it = pending.find(next); it != pending.end(); it = pending.find(next)) {
+            out += it->second;
+            pending.erase(it);
+            next++;
+        }
         return true;
     }
+
+    bool complete() const { return count && next == count; }
+    uint64_t duplicates() const { return dups; }
+    uint64_t reordered()  const { return ooo; }
+
+    /**
+     * @brief Retorna (e consome) os bytes já reconstruídos em ordem.
+     */
+    string take() { string r; r.swap(out); return r; }
+};
+
+/**
+ * @struct StripeStats
+ * @brief Contadores de uma sessão do StripedSender.
+ */
+struct StripeStats {
+    uint64_t chunks  = 0; ///< Blocos confirmados nesta sessão
+    uint32_t stalls  = 0; ///< Envios que esgotaram as retransmissões
+    uint32_t revives = 0; ///< Revives bem-sucedidos após stall
+    bool     alive   = false;
+};
+
+/**
+ * @class StripedSender
+ * @brief Espalha um stream lógico por K sessões SLOW ao mesmo central.
+ *
+ * Uma única sessão fica limitada à janela de 16 bits (e sendData() ainda
+ * espera cada fragmento ser confirmado). Aqui cada sessão roda em sua própria
+ * thread e mantém até a sua janela em trânsito (sendNoWait/pumpAcks), puxando
+ * blocos de uma fila comum à medida que os ACKs liberam espaço; sessões
+ * rápidas levam mais blocos. Se uma sessão trava, os blocos não confirmados
+ * voltam para a frente da fila, outras sessões assumem e a travada tenta
+ * revive antes de voltar a puxar trabalho. A revive tem prazo
+ * (REVIVE_TIMEOUT_MS) e é abandonada se o stream terminar antes: send()
+ * retorna quando o último bloco é confirmado, não quando a revive acaba.
+ */
+class StripedSender {
+private:
+    vector<unique_ptr<UDPPeripheral>> sessions;
+    vector<StripeStats>               sessionStats;
+    static const int MAX_REVIVES = 2; ///< Revives por sessão antes de descartá-la
+
+    mutex              mtx;
+    condition_variable cv;
+    deque<uint32_t>    queue;   ///< Índices de blocos a enviar
+    uint32_t           acked = 0;
+    size_t             alive = 0;
+    size_t             inFlightBytes = 0; ///< Bytes em trânsito somando todas as sessões
+    size_t             peakBytes     = 0; ///< Maior inFlightBytes do último send()
+    static const int   PUMP_MS = 50;      ///< Espera máxima por ACK entre reenvios
+    static const int   REVIVE_SLICE_MS   = 100;  ///< Espera por REVIVE antes de reenviá-lo
+    static const int   REVIVE_TIMEOUT_MS = 2000; ///< Prazo total do revive após um stall
+
+    bool finished(uint32_t count) {
+        lock_guard<mutex> lk(mtx);
+        return acked == count;
+    }
+
+    /**
+     * @brief Revive após stall, em fatias de REVIVE_SLICE_MS até
+     *        REVIVE_TIMEOUT_MS. Desiste assim que o stream termina, para não
+     *        segurar send() depois que as outras sessões confirmaram tudo.
+     * @return 1 revivida, 0 falhou, -1 abandonada porque o stream terminou
+     */
+    int reviveAfterStall(UDPPeripheral& s, uint32_t count) {
+        s.storeSession();
+        auto deadline = chrono::steady_clock::now() + chrono::milliseconds(REVIVE_TIMEOUT_MS);
+        while (chrono::steady_clock::now() < deadline) {
+            if (finished(count)) return -1;
+            if (s.zeroWay("", REVIVE_SLICE_MS)) return 1;
+        }
+        return finished(count) ? -1 : 0;
+    }
+
+    static size_t chunkBytes(const string& data, uint32_t idx) {
+        size_t off = (size_t)idx * STRIPE_CHUNK;
+        return STRIPE_HDR + std::min((size_t)STRIPE_CHUNK, data.size() - off);
+    }
+
+    /**
+     * @brief Laço de uma sessão: enche a janela com blocos da fila, processa
+     *        ACKs e repete até o stream terminar.
+     */
+    void worker(size_t i, const string& data, uint32_t streamId, uint32_t count) {
+        UDPPeripheral& s = *sessions[i];
+        int revives = 0;
+        map<uint32_t, uint32_t> inflight; ///< seq -> índice do bloco
+        vector<uint32_t> batch, acks;
+
+        while (true) {
+            // Reserva tantos blocos quantos couberem na janela desta sessão
+            batch.clear();
+            {
+                unique_lock<mutex> lk(mtx);
+                if (inflight.empty())
+                    cv.wait(lk, [&] { return !queue.empty() || acked == count; });
+                if (acked == count) return;
+                size_t room = s.freeWindow();
+                while (!queue.empty()) {
+                    size_t len = chunkBytes(data, queue.front());
+                    if (len > room && !(inflight.empty() && batch.empty())) break;
+                    room -= std::min(room, len);
+                    batch.push_back(queue.front());
+                    queue.pop_front();
+                }
+            }
+
+            size_t sent = 0;
+            for (size_t b = 0; b < batch.size(); b++) {
+                uint32_t idx = batch[b], seq;
+                size_t off = (size_t)idx * STRIPE_CHUNK;
+                if (!s.sendNoWait(packStripe(streamId, idx, count, data.data() + off,
+                                             chunkBytes(data, idx) - STRIPE_HDR), seq)) {
+                    lock_guard<mutex> lk(mtx);
+                    queue.insert(queue.begin(), batch.begin() + b, batch.end());
+                    break;
+                }
+                inflight[seq] = idx;
+                sent += chunkBytes(data, idx);
+            }
+            if (sent) {
+                lock_guard<mutex> lk(mtx);
+                inFlightBytes += sent;
+                peakBytes = std::max(peakBytes, inFlightBytes);
+            }
+
+            acks.clear();
+            bool ok = s.pumpAcks(PUMP_MS, acks);
+            if (!acks.empty()) {
+                lock_guard<mutex> lk(mtx);
+                for (uint32_t seq : acks) {
+                    auto it = inflight.find(seq);
+                    if (it == inflight.end()) continue;
+                    inFlightBytes -= chunkBytes(data, it->second);
+                    inflight.erase(it);
+                    sessionStats[i].chunks++;
+                    acked++;
+                }
+                if (acked == count) cv.notify_all();
+            }
+            if (ok) continue;
+
+            // Stall: devolve os blocos não confirmados e tenta reviver esta sessão
+            s.dropPending();
+            {
+                lock_guard<mutex> lk(mtx);
+                for (auto it = inflight.rbegin(); it != inflight.rend(); ++it) {
+                    queue.push_front(it->second);
+                    inFlightBytes -= chunkBytes(data, it->second);
+                }
+                sessionStats[i].stalls++;
+            }
+            inflight.clear();
+            cv.notify_all();
+
+            // Stream já concluído pelas outras sessões: a revive fica para o
+            // próximo send(), sem descartar a sessão
+            int rv = revives < MAX_REVIVES ? reviveAfterStall(s, count) : 0;
+            if (rv < 0) return;
+            if (rv > 0) {
+                revives++;
+                lock_guard<mutex> lk(mtx);
+                sessionStats[i].revives++;
+                continue;
+            }
+
+            lock_guard<mutex> lk(mtx);
+            sessionStats[i].alive = false;
+            alive--;
+            cv.notify_all();
+            return;
+        }
+    }
+
+public:
+    explicit StripedSender(size_t k) {
+        for (size_t i = 0; i < std::max<size_t>(k, 1); i++)
+            sessions.emplace_back(new UDPPeripheral());
+        sessionStats.resize(sessions.size());
+    }
+
+    /**
+     * @brief Abre as K sessões: dispara as K resoluções de uma vez e só
+     *        então faz os handshakes, um por sessão.
+     * @return true se ao menos uma sessão conectou
+     */
+    bool open(const char* host, int port) {
+        alive = 0;
+        vector<bool> started(sessions.size());
+        for (size_t i = 0; i < sessions.size(); i++)
+            started[i] = sessions[i]->init(host, port);
+        for (size_t i = 0; i < sessions.size(); i++) {
+            sessionStats[i].alive = started[i] && sessions[i]->connect();
+            if (sessionStats[i].alive) alive++;
+        }
+        return alive > 0;
+    }
+
+    /**
+     * @brief Envia @p data dividido em blocos de STRIPE_CHUNK pelas sessões vivas.
+     * @return true quando todos os blocos foram confirmados
+     */
+    bool send(const string& data, uint32_t streamId) {
+        size_t chunks = (data.size() + STRIPE_CHUNK - 1) / STRIPE_CHUNK;
+        if (chunks > STRIPE_MAX_CHUNKS) return false;
+        uint32_t count = (uint32_t)chunks;
+        if (count == 0 || alive == 0) return count == 0;
+
+        queue.clear();
+        for (uint32_t i = 0; i < count; i++) queue.push_back(i);
+        acked = 0;
+        inFlightBytes = peakBytes = 0;
+
+        vector<thread> threads;
+        for (size_t i = 0; i < sessions.size(); i++)
+            if (sessionStats[i].alive)
+                threads.emplace_back(&StripedSender::worker, this, i, cref(data), streamId, count);
+
+        // Se todas as sessões morrerem, libera quem ainda espera na fila
+        bool ok;
+        {
+            unique_lock<mutex> lk(mtx);
+            cv.wait(lk, [&] { return acked == count || alive == 0; });
+            ok = (acked == count);
+            if (!ok) { queue.clear(); acked = count; cv.notify_all(); }
+        }
+        for (thread& t : threads) t.join();
+        return ok;
+    }
+
+    /**
+     * @brief Encerra todas as sessões ainda vivas.
+     */
+    void close() {
+        for (size_t i = 0; i < sessions.size(); i++)
+            if (sessionStats[i].alive) sessions[i]->disconnect();
+    }
+
+    size_t sessionCount() const { return sessions.size(); }
+    const vector<StripeStats>& stats() const { return sessionStats; }
+
+    /**
+     * @brief Maior volume em trânsito (todas as sessões) no último send().
+     */
+    size_t peakInFlight() const { return peakBytes; }
 };
 
 
 
+#ifndef SLOW_NO_MAIN // definido por slow_bench.cpp para reaproveitar o protocolo
+
 // ---------------------- Interação com usuário ----------------------
 
 
@@ -622,6 +1364,10 @@ void printStatus(const UDPPeripheral& p, bool connected) {
     cout << "│ Servidor: slow.gmelodie.com:7033            │\n";
     cout << "│ Conexão:  " << (connected ? "[CONECTADO]   " : "[DESCONECTADO]") << "            │\n";
     cout << "│ Sessão:   " << (p.canRevive() ? "[DISPONÍVEL]  " : "[INDISPONÍVEL]") << "            │\n";
+    const LinkStats& s = p.stats();
+    cout << "│ Buffers:  rcv " << setw(8) << s.rcvBuf << " snd " << setw(8) << s.sndBuf << "         │\n";
+    cout << "│ Descartes (kernel): " << setw(10) << s.kernelDrops << "              │\n";
+    cout << "│ RTT suavizado: " << setw(10) << s.srttUs << " µs                │\n";
     cout << "└─────────────────────────────────────────────┘\n";
 }
 
@@ -641,8 +1387,8 @@ string getInput(const string& prompt) {
  * @brief Função principal: gerencia loop de comandos interativos.
  */
 int main() {
-    printWelcome();
-
+    // A resolução DNS começa antes de qualquer outra coisa e corre em
+    // segundo plano enquanto o cabeçalho é impresso
     UDPPeripheral p;
     bool connected = false;
 
@@ -651,6 +1397,8 @@ int main() {
         return 1;
     }
 
+    printWelcome();
+
     if (!p.connect()) {
         cerr << "[ERRO] Falha na conexão com o servidor!\n";
         return 1;
@@ -743,4 +1491,6 @@ int main() {
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+#endif // SLOW_NO_MAIN